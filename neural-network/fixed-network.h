@@ -0,0 +1,152 @@
+#pragma once
+
+#include "model-io.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Feed-forward network whose layer sizes are compile-time constants, e.g.
+// FixedNetwork<2, 4, 1>. All parameters live in std::array and the forward
+// pass is expanded over index sequences, so it compiles to straight-line code
+// with no loops. Intended for small models; code size grows with the number
+// of weights. Uses the same
+// activations (sigmoid hidden, linear output) and model file format as
+// NeuralNetwork, so a model trained at runtime can be loaded here for inference.
+template <int... Sizes>
+class FixedNetwork {
+    static_assert(sizeof...(Sizes) >= 2, "FixedNetwork needs at least an input and an output layer");
+    static_assert(((Sizes > 0) && ...), "FixedNetwork layer sizes must be positive");
+
+public:
+    static constexpr std::size_t kLayerCount = sizeof...(Sizes);
+    static constexpr std::array<int, kLayerCount> kTopology = {Sizes...};
+    static constexpr int kInputSize = kTopology.front();
+    static constexpr int kOutputSize = kTopology.back();
+
+    using Input = std::array<double, kInputSize>;
+    using Output = std::array<double, kOutputSize>;
+
+private:
+    static constexpr std::size_t weightOffset(std::size_t layer) {
+        std::size_t offset = 0;
+        for (std::size_t i = 0; i < layer; ++i) {
+            offset += static_cast<std::size_t>(kTopology[i]) * kTopology[i + 1];
+        }
+        return offset;
+    }
+
+    static constexpr std::size_t biasOffset(std::size_t layer) {
+        std::size_t offset = 0;
+        for (std::size_t i = 0; i < layer; ++i) {
+            offset += kTopology[i + 1];
+        }
+        return offset;
+    }
+
+    static constexpr std::size_t maxWidth() {
+        int width = 0;
+        for (int size : kTopology) {
+            width = std::max(width, size);
+        }
+        return static_cast<std::size_t>(width);
+    }
+
+    static constexpr std::size_t kWeightCount = weightOffset(kLayerCount - 1);
+    static constexpr std::size_t kBiasCount = biasOffset(kLayerCount - 1);
+    static constexpr std::size_t kMaxWidth = maxWidth();
+
+    // Flattened parameters, same [layer][from][to] order as the model file
+    std::array<double, kWeightCount> weights{};
+    std::array<double, kBiasCount> biases{};
+
+    static double sigmoid(double x) {
+        return 1.0 / (1.0 + std::exp(-x));
+    }
+
+    // Weighted sum for neuron K of layer L + 1, expanded over the inputs J.
+    // Left fold keeps NeuralNetwork's summation order, so results match exactly.
+    template <std::size_t L, std::size_t K, std::size_t... J>
+    double neuron(const double* in, std::index_sequence<J...>) const {
+        constexpr std::size_t to = kTopology[L + 1];
+        constexpr std::size_t w = weightOffset(L);
+        return (biases[biasOffset(L) + K] + ... + (in[J] * weights[w + J * to + K]));
+    }
+
+    template <std::size_t L>
+    static double activate(double sum) {
+        if constexpr (L + 2 == kLayerCount) {
+            return sum; // Linear activation for output layer
+        } else {
+            return sigmoid(sum); // Sigmoid for hidden layers
+        }
+    }
+
+    // Propagates layer L -> L + 1, expanded over the outputs K so no loop remains
+    template <std::size_t L, std::size_t... K>
+    void forwardLayer(const double* in, double* out, std::index_sequence<K...>) const {
+        ((out[K] = activate<L>(neuron<L, K>(in, std::make_index_sequence<kTopology[L]>{}))), ...);
+    }
+
+    template <std::size_t... L>
+    Output forward(const Input& inputs, std::index_sequence<L...>) const {
+        // Hidden layers ping-pong between two scratch buffers; the first layer
+        // reads the inputs and the last writes the outputs in place
+        std::array<std::array<double, kMaxWidth>, 2> buffers;
+        Output outputs;
+        (forwardLayer<L>(L == 0 ? inputs.data() : buffers[L % 2].data(),
+                         L + 2 == kLayerCount ? outputs.data() : buffers[(L + 1) % 2].data(),
+                         std::make_index_sequence<kTopology[L + 1]>{}), ...);
+        return outputs;
+    }
+
+public:
+    FixedNetwork() {
+        std::mt19937 gen(std::random_device{}());
+        std::uniform_real_distribution<double> dis(-1.0, 1.0);
+        for (double& w : weights) {
+            w = dis(gen);
+        }
+        for (double& b : biases) {
+            b = dis(gen);
+        }
+    }
+
+    Output feedForward(const Input& inputs) const {
+        return forward(inputs, std::make_index_sequence<kLayerCount - 1>{});
+    }
+
+    bool saveModel(const std::string& filename) const {
+        ModelData model;
+        model.topology.assign(kTopology.begin(), kTopology.end());
+        model.weights.assign(weights.begin(), weights.end());
+        model.biases.assign(biases.begin(), biases.end());
+        return writeModelFile(filename, model);
+    }
+
+    // Copies parameters from a runtime NeuralNetwork (see NeuralNetwork::toModelData).
+    // Fails without modifying the network if the topology differs.
+    bool load(const ModelData& model) {
+        if (!std::equal(model.topology.begin(), model.topology.end(),
+                        kTopology.begin(), kTopology.end()) ||
+            model.weights.size() != kWeightCount || model.biases.size() != kBiasCount) {
+            std::cerr << "Model topology does not match FixedNetwork" << std::endl;
+            return false;
+        }
+
+        std::copy(model.weights.begin(), model.weights.end(), weights.begin());
+        std::copy(model.biases.begin(), model.biases.end(), biases.begin());
+        return true;
+    }
+
+    bool loadModel(const std::string& filename) {
+        ModelData model;
+        return readModelFile(filename, model) && load(model);
+    }
+};
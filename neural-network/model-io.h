@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Flattened model parameters shared by NeuralNetwork and FixedNetwork.
+// Weights are stored layer by layer in [from][to] order, biases layer by layer.
+struct ModelData {
+    std::vector<int> topology;
+    std::vector<double> weights;
+    std::vector<double> biases;
+};
+
+// Training state needed to resume NeuralNetwork::train exactly where it left off
+struct CheckpointData {
+    int nextEpoch = 0;
+    double learningRate = 0.0;
+    double bestError = 0.0;
+    int bestEpoch = -1;
+    int epochsWithoutImprovement = 0;
+    ModelData model;
+    bool hasBest = false; // best is only stored when best weights are tracked
+    ModelData best;
+};
+
+// Non-finite parameters (from a diverged run) are refused, since they cannot be read back
+bool writeModelFile(const std::string& filename, const ModelData& model);
+bool readModelFile(const std::string& filename, ModelData& model);
+
+// Checkpoints are written to a temporary file and renamed into place, so a
+// crash mid-write leaves the previous checkpoint intact (atomic on POSIX only)
+bool writeCheckpointFile(const std::string& filename, const CheckpointData& checkpoint);
+bool readCheckpointFile(const std::string& filename, CheckpointData& checkpoint);
+
+// True if a checkpoint, or a temporary file left by an interrupted replace, exists
+bool checkpointExists(const std::string& filename);
@@ -5,6 +5,51 @@
 #include <random>
 #include <iostream>
 #include <algorithm>
+#include <string>
+
+#include "model-io.h"
+
+// Options for NeuralNetwork::train. Validation, early stopping and
+// checkpointing are each disabled by their default values.
+struct TrainOptions {
+    int epochs = 1000;
+    int logInterval = 100;
+
+    // Held-out validation set. If empty, the trailing validationSplit fraction
+    // (clamped to [0, 1)) of the training data is held out instead.
+    std::vector<std::vector<double>> validationInputs;
+    std::vector<std::vector<double>> validationTargets;
+    double validationSplit = 0.0;
+
+    // Stop after this many epochs without the monitored error improving by
+    // more than minDelta (0 disables early stopping). The monitored error is
+    // the validation error, or the training error when there is no validation set.
+    int patience = 0;
+    double minDelta = 0.0;
+    // Restore the weights of the best epoch when training ends; only takes
+    // effect when early stopping is enabled (patience > 0)
+    bool restoreBestWeights = true;
+
+    // Write a checkpoint every checkpointInterval epochs and when training ends;
+    // with resume set, training continues from an existing checkpoint, and
+    // fails without writing anything if that checkpoint cannot be used. The
+    // checkpoint is replaced atomically on POSIX only.
+    std::string checkpointFile;
+    int checkpointInterval = 0;
+    bool resume = false;
+};
+
+struct TrainResult {
+    // One past the last completed epoch, counting epochs from resumed checkpoints
+    int finalEpoch = 0;
+    int bestEpoch = -1;
+    // Lowest monitored error: validation error if a validation set was used,
+    // otherwise training error
+    double bestError = 0.0;
+    bool stoppedEarly = false;
+    // Set when training did not run because of invalid data or an unusable checkpoint
+    bool failed = false;
+};
 
 class NeuralNetwork {
 private:
@@ -23,6 +68,8 @@ private:
     // Random number generator
     std::mt19937 gen;
     std::uniform_real_distribution<double> dis;
+    
+    void fromModelData(const ModelData& model);
 
 public:
     NeuralNetwork(const std::vector<int>& topology, double lr = 0.01);
@@ -34,11 +81,17 @@ public:
     void train(const std::vector<std::vector<double>>& inputs,
               const std::vector<std::vector<double>>& targets,
               int epochs);
+    TrainResult train(const std::vector<std::vector<double>>& inputs,
+                      const std::vector<std::vector<double>>& targets,
+                      const TrainOptions& options);
     
     // Utility functions
     double calculateError(const std::vector<double>& outputs,
                          const std::vector<double>& targets);
+    double evaluate(const std::vector<std::vector<double>>& inputs,
+                    const std::vector<std::vector<double>>& targets);
     void printWeights();
-    void saveModel(const std::string& filename);
-    void loadModel(const std::string& filename);
+    ModelData toModelData() const; // Flattened parameters, e.g. for FixedNetwork::load
+    bool saveModel(const std::string& filename);
+    bool loadModel(const std::string& filename);
 };
\ No newline at end of file
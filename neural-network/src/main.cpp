@@ -1,5 +1,7 @@
 #include "../neural-network.h"
+#include "../fixed-network.h"
 
+#include <chrono>
 #include <iostream>
 #include <vector>
 
@@ -34,5 +36,41 @@ int main() {
         std::cout << "Got: " << output[0] << std::endl;
     }
     
+    // Hand the trained weights to the compile-time network for fast inference
+    FixedNetwork<2, 4, 1> fixed;
+    if (fixed.load(nn.toModelData())) {
+        std::cout << "\nFixed-topology network:" << std::endl;
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            auto output = fixed.feedForward({inputs[i][0], inputs[i][1]});
+            std::cout << "Input: [" << inputs[i][0] << ", " << inputs[i][1] << "] ";
+            std::cout << "Got: " << output[0] << std::endl;
+        }
+        
+        // Compare per-call inference time; the sums keep the calls from being optimized away
+        const int iterations = 1000000;
+        double runtimeSum = 0.0;
+        double fixedSum = 0.0;
+        
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            runtimeSum += nn.feedForward(inputs[i % inputs.size()])[0];
+        }
+        auto runtimeTime = std::chrono::steady_clock::now() - start;
+        
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            const auto& input = inputs[i % inputs.size()];
+            fixedSum += fixed.feedForward({input[0], input[1]})[0];
+        }
+        auto fixedTime = std::chrono::steady_clock::now() - start;
+        
+        std::cout << "\nNeuralNetwork::feedForward: "
+                  << std::chrono::duration<double, std::nano>(runtimeTime).count() / iterations
+                  << " ns/call (checksum " << runtimeSum << ")" << std::endl;
+        std::cout << "FixedNetwork::feedForward: "
+                  << std::chrono::duration<double, std::nano>(fixedTime).count() / iterations
+                  << " ns/call (checksum " << fixedSum << ")" << std::endl;
+    }
+    
     return 0;
 }
@@ -0,0 +1,255 @@
+#include "../model-io.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <utility>
+
+namespace {
+
+const char* const kCheckpointTag = "checkpoint";
+
+// Upper bounds that keep a corrupt header from triggering huge allocations
+const size_t kMaxLayerCount = 1024;
+const int kMaxLayerSize = 1 << 20;
+const size_t kMaxParameterCount = size_t(1) << 26;
+
+size_t weightCount(const std::vector<int>& topology) {
+    size_t count = 0;
+    for (size_t i = 0; i + 1 < topology.size(); ++i) {
+        count += static_cast<size_t>(topology[i]) * topology[i + 1];
+    }
+    return count;
+}
+
+size_t biasCount(const std::vector<int>& topology) {
+    size_t count = 0;
+    for (size_t i = 1; i < topology.size(); ++i) {
+        count += topology[i];
+    }
+    return count;
+}
+
+bool isFinite(const ModelData& model) {
+    for (double w : model.weights) {
+        if (!std::isfinite(w)) {
+            return false;
+        }
+    }
+    for (double b : model.biases) {
+        if (!std::isfinite(b)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string tmpFilename(const std::string& filename) {
+    return filename + ".tmp";
+}
+
+void writeModel(std::ostream& out, const ModelData& model) {
+    out << model.topology.size() << "\n";
+    for (int size : model.topology) {
+        out << size << " ";
+    }
+    out << "\n";
+
+    for (double w : model.weights) {
+        out << w << " ";
+    }
+    out << "\n";
+
+    for (double b : model.biases) {
+        out << b << " ";
+    }
+    out << "\n";
+}
+
+// On failure sets error to a description of the part that could not be read
+bool readModel(std::istream& in, ModelData& model, std::string& error) {
+    size_t layerCount = 0;
+    in >> layerCount;
+    if (!in || layerCount < 2 || layerCount > kMaxLayerCount) {
+        error = "Invalid model header";
+        return false;
+    }
+
+    model.topology.resize(layerCount);
+    for (int& size : model.topology) {
+        in >> size;
+        if (!in || size <= 0 || size > kMaxLayerSize) {
+            error = "Invalid model topology";
+            return false;
+        }
+    }
+    if (weightCount(model.topology) + biasCount(model.topology) > kMaxParameterCount) {
+        error = "Model too large";
+        return false;
+    }
+
+    model.weights.resize(weightCount(model.topology));
+    for (double& w : model.weights) {
+        in >> w;
+    }
+    model.biases.resize(biasCount(model.topology));
+    for (double& b : model.biases) {
+        in >> b;
+    }
+    if (!in) {
+        error = "Truncated model file";
+        return false;
+    }
+    return true;
+}
+
+// True if only whitespace remains in the stream
+bool atEnd(std::istream& in) {
+    in >> std::ws;
+    return in.eof();
+}
+
+} // namespace
+
+bool writeModelFile(const std::string& filename, const ModelData& model) {
+    if (!isFinite(model)) {
+        std::cerr << "Refusing to save model with non-finite parameters: " << filename << std::endl;
+        return false;
+    }
+
+    std::ofstream file(filename);
+    if (!file) {
+        std::cerr << "Error opening model file for writing: " << filename << std::endl;
+        return false;
+    }
+
+    // Full round-trip precision so a loaded model reproduces the saved one exactly
+    file.precision(std::numeric_limits<double>::max_digits10);
+    writeModel(file, model);
+
+    if (!file) {
+        std::cerr << "Error writing model file: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool readModelFile(const std::string& filename, ModelData& model) {
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Error opening model file: " << filename << std::endl;
+        return false;
+    }
+
+    ModelData loaded;
+    std::string error;
+    if (!readModel(file, loaded, error)) {
+        std::cerr << error << ": " << filename << std::endl;
+        return false;
+    }
+    if (!atEnd(file)) {
+        std::cerr << "Unexpected data after model: " << filename << std::endl;
+        return false;
+    }
+
+    model = std::move(loaded);
+    return true;
+}
+
+bool writeCheckpointFile(const std::string& filename, const CheckpointData& checkpoint) {
+    if (!isFinite(checkpoint.model) || (checkpoint.hasBest && !isFinite(checkpoint.best)) ||
+        !std::isfinite(checkpoint.learningRate) || !std::isfinite(checkpoint.bestError)) {
+        std::cerr << "Refusing to write checkpoint with non-finite values, keeping previous one: "
+                  << filename << std::endl;
+        return false;
+    }
+
+    const std::string tmpName = tmpFilename(filename);
+    {
+        std::ofstream file(tmpName);
+        if (!file) {
+            std::cerr << "Error opening checkpoint file for writing: " << tmpName << std::endl;
+            return false;
+        }
+
+        file.precision(std::numeric_limits<double>::max_digits10);
+        file << kCheckpointTag << "\n";
+        file << checkpoint.nextEpoch << " " << checkpoint.learningRate << " "
+             << checkpoint.bestError << " " << checkpoint.bestEpoch << " "
+             << checkpoint.epochsWithoutImprovement << " " << checkpoint.hasBest << "\n";
+        writeModel(file, checkpoint.model);
+        if (checkpoint.hasBest) {
+            writeModel(file, checkpoint.best);
+        }
+
+        file.flush();
+        if (!file) {
+            std::cerr << "Error writing checkpoint file: " << tmpName << std::endl;
+            std::remove(tmpName.c_str());
+            return false;
+        }
+    }
+
+    // rename() atomically replaces the previous checkpoint on POSIX. Windows
+    // refuses to overwrite, so remove the old file first there; a crash in
+    // between leaves only the .tmp file, which readCheckpointFile falls back to.
+    bool renamed = std::rename(tmpName.c_str(), filename.c_str()) == 0;
+#ifdef _WIN32
+    if (!renamed) {
+        renamed = std::remove(filename.c_str()) == 0 &&
+                  std::rename(tmpName.c_str(), filename.c_str()) == 0;
+    }
+#endif
+    if (!renamed) {
+        std::cerr << "Error replacing checkpoint file: " << filename << std::endl;
+        std::remove(tmpName.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool checkpointExists(const std::string& filename) {
+    return std::ifstream(filename) || std::ifstream(tmpFilename(filename));
+}
+
+bool readCheckpointFile(const std::string& filename, CheckpointData& checkpoint) {
+    std::ifstream file(filename);
+    if (!file) {
+        // An interrupted replace can leave only the temporary file
+        file.open(tmpFilename(filename));
+        if (!file) {
+            std::cerr << "Error opening checkpoint file: " << filename << std::endl;
+            return false;
+        }
+        std::cerr << "Checkpoint missing, reading " << tmpFilename(filename) << std::endl;
+    }
+
+    std::string tag;
+    CheckpointData loaded;
+    file >> tag >> loaded.nextEpoch >> loaded.learningRate >> loaded.bestError
+         >> loaded.bestEpoch >> loaded.epochsWithoutImprovement >> loaded.hasBest;
+    if (!file || tag != kCheckpointTag) {
+        std::cerr << "Invalid checkpoint header: " << filename << std::endl;
+        return false;
+    }
+
+    std::string error;
+    if (!readModel(file, loaded.model, error) ||
+        (loaded.hasBest && !readModel(file, loaded.best, error))) {
+        std::cerr << error << ": " << filename << std::endl;
+        return false;
+    }
+    if (loaded.hasBest && loaded.model.topology != loaded.best.topology) {
+        std::cerr << "Checkpoint best model topology does not match: " << filename << std::endl;
+        return false;
+    }
+    if (!atEnd(file)) {
+        std::cerr << "Unexpected data after checkpoint: " << filename << std::endl;
+        return false;
+    }
+
+    checkpoint = std::move(loaded);
+    return true;
+}
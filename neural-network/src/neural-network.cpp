@@ -1,7 +1,7 @@
 #include "../neural-network.h"
 
-#include <fstream>
-#include <sstream>
+#include <limits>
+#include <utility>
 
 NeuralNetwork::NeuralNetwork(const std::vector<int>& topology, double lr)
     : topology(topology), learningRate(lr), gen(std::random_device{}()), dis(-1.0, 1.0) {
@@ -118,19 +118,183 @@ void NeuralNetwork::backPropagate(const std::vector<double>& inputs,
 void NeuralNetwork::train(const std::vector<std::vector<double>>& inputs,
                          const std::vector<std::vector<double>>& targets,
                          int epochs) {
-    for (int epoch = 0; epoch < epochs; ++epoch) {
+    TrainOptions options;
+    options.epochs = epochs;
+    train(inputs, targets, options);
+}
+
+TrainResult NeuralNetwork::train(const std::vector<std::vector<double>>& inputs,
+                                 const std::vector<std::vector<double>>& targets,
+                                 const TrainOptions& options) {
+    TrainResult result;
+    
+    if (inputs.size() != targets.size()) {
+        std::cerr << "Training inputs and targets differ in size" << std::endl;
+        result.failed = true;
+        return result;
+    }
+    if (options.validationInputs.size() != options.validationTargets.size()) {
+        std::cerr << "Validation inputs and targets differ in size" << std::endl;
+        result.failed = true;
+        return result;
+    }
+    if (inputs.empty()) {
+        return result;
+    }
+    
+    // Hold out the trailing validationSplit fraction unless a validation set was given
+    size_t trainCount = inputs.size();
+    std::vector<std::vector<double>> splitInputs;
+    std::vector<std::vector<double>> splitTargets;
+    // Clamp the split to [0, 1]; a NaN split counts as 0. At least one sample
+    // is always kept for training.
+    double split = options.validationSplit > 0.0 ? std::min(options.validationSplit, 1.0) : 0.0;
+    if (options.validationInputs.empty() && split > 0.0) {
+        size_t heldOut = static_cast<size_t>(inputs.size() * split);
+        heldOut = std::min(heldOut, inputs.size() - 1);
+        if (heldOut == 0) {
+            std::cerr << "Validation split holds out no samples, training without validation"
+                      << std::endl;
+        }
+        trainCount = inputs.size() - heldOut;
+        splitInputs.assign(inputs.begin() + trainCount, inputs.end());
+        splitTargets.assign(targets.begin() + trainCount, targets.end());
+    }
+    const auto& validationInputs = splitInputs.empty() ? options.validationInputs : splitInputs;
+    const auto& validationTargets = splitInputs.empty() ? options.validationTargets : splitTargets;
+    const bool hasValidation = !validationInputs.empty();
+    
+    // Early stopping monitors the validation error, or the training error without one
+    int startEpoch = 0;
+    double bestError = std::numeric_limits<double>::max();
+    int bestEpoch = -1;
+    int epochsWithoutImprovement = 0;
+    const bool keepBest = options.patience > 0 && options.restoreBestWeights;
+    ModelData bestModel;
+    
+    const bool checkpointing = !options.checkpointFile.empty();
+    if (checkpointing && options.resume && checkpointExists(options.checkpointFile)) {
+        // Never fall back to a fresh start here: the next checkpoint write
+        // would overwrite the state the caller asked to resume from
+        CheckpointData checkpoint;
+        if (!readCheckpointFile(options.checkpointFile, checkpoint)) {
+            std::cerr << "Cannot resume from checkpoint, not training" << std::endl;
+            result.failed = true;
+            return result;
+        } else if (checkpoint.model.topology != topology) {
+            std::cerr << "Checkpoint topology does not match network, not training: "
+                      << options.checkpointFile << std::endl;
+            result.failed = true;
+            return result;
+        } else {
+            fromModelData(checkpoint.model);
+            learningRate = checkpoint.learningRate;
+            startEpoch = checkpoint.nextEpoch;
+            bestError = checkpoint.bestError;
+            bestEpoch = checkpoint.bestEpoch;
+            epochsWithoutImprovement = checkpoint.epochsWithoutImprovement;
+            if (keepBest && checkpoint.hasBest) {
+                bestModel = std::move(checkpoint.best);
+            } else if (keepBest && bestEpoch >= 0) {
+                // The best weights were not saved, so restart best tracking from here
+                std::cerr << "Checkpoint has no best weights, resetting early stopping state"
+                          << std::endl;
+                bestError = std::numeric_limits<double>::max();
+                bestEpoch = -1;
+                epochsWithoutImprovement = 0;
+            }
+            std::cout << "Resuming training from epoch " << startEpoch << std::endl;
+        }
+    }
+    
+    auto saveCheckpoint = [&](int nextEpoch) {
+        CheckpointData checkpoint;
+        checkpoint.nextEpoch = nextEpoch;
+        checkpoint.learningRate = learningRate;
+        checkpoint.bestError = bestError;
+        checkpoint.bestEpoch = bestEpoch;
+        checkpoint.epochsWithoutImprovement = epochsWithoutImprovement;
+        checkpoint.model = toModelData();
+        checkpoint.hasBest = !bestModel.topology.empty();
+        if (checkpoint.hasBest) {
+            checkpoint.best = bestModel;
+        }
+        writeCheckpointFile(options.checkpointFile, checkpoint);
+    };
+    
+    int epoch = startEpoch;
+    for (; epoch < options.epochs; ++epoch) {
+        if (options.patience > 0 && epochsWithoutImprovement >= options.patience) {
+            result.stoppedEarly = true;
+            break;
+        }
+        
         double totalError = 0.0;
         
-        for (size_t i = 0; i < inputs.size(); ++i) {
+        for (size_t i = 0; i < trainCount; ++i) {
             backPropagate(inputs[i], targets[i]);
             auto output = feedForward(inputs[i]);
             totalError += calculateError(output, targets[i]);
         }
         
-        if (epoch % 100 == 0) {
-            std::cout << "Epoch " << epoch << ", Error: " << totalError / inputs.size() << std::endl;
+        double trainError = totalError / trainCount;
+        double validationError = hasValidation ? evaluate(validationInputs, validationTargets) : 0.0;
+        double monitoredError = hasValidation ? validationError : trainError;
+        
+        if (monitoredError < bestError - options.minDelta) {
+            bestError = monitoredError;
+            bestEpoch = epoch;
+            epochsWithoutImprovement = 0;
+            if (keepBest) {
+                bestModel = toModelData();
+            }
+        } else {
+            ++epochsWithoutImprovement;
         }
+        
+        if (options.logInterval > 0 && epoch % options.logInterval == 0) {
+            std::cout << "Epoch " << epoch << ", Error: " << trainError;
+            if (hasValidation) {
+                std::cout << ", Validation Error: " << validationError;
+            }
+            std::cout << std::endl;
+        }
+        
+        if (checkpointing && options.checkpointInterval > 0 &&
+            (epoch + 1) % options.checkpointInterval == 0) {
+            saveCheckpoint(epoch + 1);
+        }
+    }
+    
+    if (checkpointing) {
+        saveCheckpoint(epoch);
+    }
+    
+    if (result.stoppedEarly) {
+        std::cout << "Early stopping after " << epoch << " epochs, best epoch " << bestEpoch
+                  << " with error " << bestError << std::endl;
+    }
+    if (keepBest && !bestModel.topology.empty()) {
+        fromModelData(bestModel);
+    }
+    
+    result.finalEpoch = epoch;
+    result.bestEpoch = bestEpoch;
+    result.bestError = bestEpoch >= 0 ? bestError : 0.0;
+    return result;
+}
+
+double NeuralNetwork::evaluate(const std::vector<std::vector<double>>& inputs,
+                              const std::vector<std::vector<double>>& targets) {
+    if (inputs.empty()) {
+        return 0.0;
+    }
+    
+    double totalError = 0.0;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        totalError += calculateError(feedForward(inputs[i]), targets[i]);
     }
+    return totalError / inputs.size();
 }
 
 double NeuralNetwork::calculateError(const std::vector<double>& outputs,
@@ -155,3 +319,53 @@ void NeuralNetwork::printWeights() {
         std::cout << std::endl;
     }
 }
+
+ModelData NeuralNetwork::toModelData() const {
+    ModelData model;
+    model.topology = topology;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        for (int j = 0; j < topology[i]; ++j) {
+            model.weights.insert(model.weights.end(), weights[i][j].begin(), weights[i][j].end());
+        }
+        model.biases.insert(model.biases.end(), biases[i].begin(), biases[i].end());
+    }
+    return model;
+}
+
+void NeuralNetwork::fromModelData(const ModelData& model) {
+    // Adopt the stored topology, resizing every buffer to match it
+    topology = model.topology;
+    layers.assign(topology.size(), {});
+    for (size_t i = 0; i < topology.size(); ++i) {
+        layers[i].resize(topology[i]);
+    }
+    weights.assign(topology.size() - 1, {});
+    biases.assign(topology.size() - 1, {});
+    
+    size_t w = 0;
+    size_t b = 0;
+    for (size_t i = 0; i < topology.size() - 1; ++i) {
+        weights[i].resize(topology[i]);
+        for (int j = 0; j < topology[i]; ++j) {
+            weights[i][j].assign(model.weights.begin() + w,
+                                 model.weights.begin() + w + topology[i + 1]);
+            w += topology[i + 1];
+        }
+        biases[i].assign(model.biases.begin() + b,
+                         model.biases.begin() + b + topology[i + 1]);
+        b += topology[i + 1];
+    }
+}
+
+bool NeuralNetwork::saveModel(const std::string& filename) {
+    return writeModelFile(filename, toModelData());
+}
+
+bool NeuralNetwork::loadModel(const std::string& filename) {
+    ModelData model;
+    if (!readModelFile(filename, model)) {
+        return false;
+    }
+    fromModelData(model);
+    return true;
+}